@@ -0,0 +1,533 @@
+#include "generators.hpp"
+#include "graphbackend/graphbackend.hpp"
+#include "randomblocks.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#  include <linux/perf_event.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+using namespace graphs;
+
+//Live heap bytes, tracked by replacing the global allocator for this executable only
+namespace allocation {
+std::atomic<int64_t> live{0};
+std::atomic<int64_t> peak{0};
+
+constexpr size_t kHeader = alignof(std::max_align_t);
+
+inline void* allocate(size_t size) {
+  char* p = static_cast<char*>(std::malloc(size + kHeader));
+  if (!p) throw std::bad_alloc();
+  *reinterpret_cast<size_t*>(p) = size;
+
+  int64_t now  = live.fetch_add(size, std::memory_order_relaxed) + size;
+  int64_t prev = peak.load(std::memory_order_relaxed);
+  while (now > prev && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+  return p + kHeader;
+}
+
+inline void release(void* ptr) {
+  if (!ptr) return;
+  char* p = static_cast<char*>(ptr) - kHeader;
+  live.fetch_sub(*reinterpret_cast<size_t*>(p), std::memory_order_relaxed);
+  std::free(p);
+}
+} // namespace allocation
+
+void* operator new(size_t size) { return allocation::allocate(size); }
+void* operator new[](size_t size) { return allocation::allocate(size); }
+void  operator delete(void* ptr) noexcept { allocation::release(ptr); }
+void  operator delete[](void* ptr) noexcept { allocation::release(ptr); }
+void  operator delete(void* ptr, size_t) noexcept { allocation::release(ptr); }
+void  operator delete[](void* ptr, size_t) noexcept { allocation::release(ptr); }
+
+//Cycles, instructions, cache and branch misses through perf_event_open, silently unavailable elsewhere
+struct HardwareCounters {
+  static constexpr int kCount = 4;
+
+  int  fds[kCount] = {-1, -1, -1, -1};
+  bool available   = false;
+
+  HardwareCounters() {
+#ifdef __linux__
+    const uint64_t configs[kCount] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+    available = true;
+    for (int i = 0; i < kCount; i++) {
+      perf_event_attr attr{};
+      attr.type           = PERF_TYPE_HARDWARE;
+      attr.size           = sizeof(attr);
+      attr.config         = configs[i];
+      attr.disabled       = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      fds[i]              = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+      if (fds[i] < 0) available = false;
+    }
+#endif
+  }
+
+  ~HardwareCounters() {
+    for (int fd : fds)
+      if (fd >= 0) ::close(fd);
+  }
+
+  void start() {
+#ifdef __linux__
+    if (!available) return;
+    for (int fd : fds) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  void stop(int64_t (&values)[kCount]) {
+    for (auto& v : values) v = -1;
+#ifdef __linux__
+    if (!available) return;
+    for (int i = 0; i < kCount; i++) {
+      ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+      uint64_t value = 0;
+      if (::read(fds[i], &value, sizeof(value)) == sizeof(value)) values[i] = value;
+    }
+#endif
+  }
+};
+
+struct Record {
+  std::string backend;
+  std::string generator;
+  std::string op;
+  uint64_t    n             = 0;
+  uint64_t    degree        = 0;
+  uint64_t    vertices      = 0;
+  double      averageDegree = 0;
+  uint64_t    ops           = 0;
+  double      totalNs       = 0;
+  int64_t     bytes         = -1;
+  int64_t     peak          = -1;
+  int64_t     counters[HardwareCounters::kCount];
+
+  double nsPerOp() const { return ops ? totalNs / ops : 0.0; }
+
+  std::string key(bool withBackend = true) const {
+    std::ostringstream s;
+    if (withBackend) s << backend << "/";
+    s << generator << "/" << op << "/" << n << "/" << degree;
+    return s.str();
+  }
+};
+
+struct Config {
+  std::vector<uint64_t> sizes   = {1000, 10000};
+  std::vector<uint64_t> degrees = {6, 32};
+  std::string           backendFilter;
+  std::string           generatorFilter;
+  std::string           jsonPath;
+  std::string           baselinePath;
+  std::string           referencePath;
+  double                threshold   = 1.25;
+  double                noiseFloor  = 1000;
+  uint64_t              queries     = 100000;
+  uint64_t              inserts     = 10000;
+  uint64_t              seed        = 0;
+  int                   repetitions = 5;
+};
+
+HardwareCounters counters;
+
+//Samples shorter than this are repeated so clock reads and timer granularity stay negligible
+constexpr double kMinSampleNs = 1e6;
+
+struct NoSetup {
+  void operator()() const {}
+};
+
+//Calls f() until kMinSampleNs has elapsed and reports the mean per call. Without setup the calls are timed in doubling
+//batches, otherwise setup() runs untimed before every call.
+template <typename Setup, typename F>
+Record measure(uint64_t ops, Setup&& setup, F&& f) {
+  constexpr bool batched = std::is_same_v<std::decay_t<Setup>, NoSetup>;
+
+  Record r;
+  r.ops = ops;
+  for (auto& c : r.counters) c = 0;
+
+  double   elapsed = 0;
+  uint64_t calls   = 0;
+  uint64_t batch   = 1;
+  int64_t  sample[HardwareCounters::kCount];
+
+  while (elapsed < kMinSampleNs) {
+    if constexpr (!batched) setup();
+    counters.start();
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < batch; i++) f();
+    auto t1 = std::chrono::steady_clock::now();
+    counters.stop(sample);
+
+    elapsed += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    calls += batch;
+    for (int c = 0; c < HardwareCounters::kCount; c++)
+      r.counters[c] = (sample[c] < 0 || r.counters[c] < 0) ? -1 : r.counters[c] + sample[c];
+    if constexpr (batched) batch *= 2;
+  }
+
+  r.totalNs = elapsed / calls;
+  for (auto& c : r.counters)
+    if (c >= 0) c /= calls;
+  return r;
+}
+
+template <typename F>
+Record measure(uint64_t ops, F&& f) {
+  return measure(ops, NoSetup{}, std::forward<F>(f));
+}
+
+//Level count whose expected tree size, sum of (0.9 * branching)^l over the levels, is closest to n on a log scale
+uint64_t treeLevels(uint64_t n, uint64_t branching) {
+  double   b        = 0.9 * branching;
+  uint64_t best     = 1;
+  double   bestDist = INFINITY;
+  double   size     = 0;
+  for (uint64_t levels = 1; levels <= 64 && size < n * b; levels++) {
+    size += std::pow(b, levels - 1);
+    double dist = std::abs(std::log(size / n));
+    if (dist < bestDist) best = levels, bestDist = dist;
+  }
+  return best;
+}
+
+template <typename Backend>
+using GeneratorFn = std::function<void(Backend&, uint64_t n, uint64_t degree, random_blocks::Xoshiro256x8&, generators::Workspace&)>;
+
+//Generators are driven by the requested n and degree, which key the records so baselines match across seeds.
+//All but recursive_tree store roughly n * degree / 2 edges. recursive_tree is a tree with branching factor degree,
+//grown to the level count whose expected size is closest to n, so its vertex count only approximates n and its
+//average degree is just under 2. Each record also carries the vertex count and average degree the graph really has.
+template <typename Backend>
+std::vector<std::pair<std::string, GeneratorFn<Backend>>> generatorCases() {
+  return {
+    {"erdos_renyi", [](Backend& g, uint64_t n, uint64_t k, auto& rng, auto&) { generators::erdos_renyi_undirected(g, n, double(k) / (n - 1), rng); }},
+    {"barabasi_albert", [](Backend& g, uint64_t n, uint64_t k, auto& rng, auto& ws) { generators::barabasi_albert_undirected(g, n, std::max<uint64_t>(k, 2), std::max<uint64_t>(k / 2, 1), rng, ws); }},
+    {"watts_strogatz", [](Backend& g, uint64_t n, uint64_t k, auto& rng, auto&) { generators::watts_strogatz_undirected(g, n, std::max<uint64_t>(k / 2, 1), 0.1, rng); }},
+    {"prefferential", [](Backend& g, uint64_t n, uint64_t k, auto& rng, auto& ws) { generators::prefferential_directed(g, n, n * k / 2, rng, ws); }},
+    {"recursive_tree", [](Backend& g, uint64_t n, uint64_t k, auto& rng, auto& ws) { generators::recursive_tree(g, treeLevels(n, k), k, 0.9f, rng, ws); }},
+  };
+}
+
+//maxVertices keeps the O(n^2) layouts and the O(E) insertion of the flat list out of sizes they cannot finish.
+//Combinations a generator rejects, or that leave an empty graph, are noted in `skipped` instead of measured.
+template <typename Backend>
+void sweepBackend(const std::string& name, uint64_t maxVertices, const Config& config, std::vector<Record>& records, std::map<std::string, std::string>& skipped) {
+  if (!config.backendFilter.empty() && name.find(config.backendFilter) == std::string::npos) return;
+
+  auto persistencePath = (std::filesystem::temp_directory_path() / "detragraphs_bench.graph").string();
+  auto io              = detra::unisIO();
+
+  for (auto& [generatorName, generate] : generatorCases<Backend>()) {
+    if (!config.generatorFilter.empty() && generatorName.find(config.generatorFilter) == std::string::npos) continue;
+
+    for (uint64_t n : config.sizes) {
+      if (n > maxVertices) continue;
+
+      for (uint64_t degree : config.degrees) {
+        uint64_t V             = 0;
+        double   averageDegree = 0;
+
+        auto push = [&](const char* op, Record r) {
+          r.backend       = name;
+          r.generator     = generatorName;
+          r.op            = op;
+          r.n             = n;
+          r.degree        = degree;
+          r.vertices      = V;
+          r.averageDegree = averageDegree;
+          records.push_back(r);
+        };
+
+        auto skip = [&](const std::string& reason) {
+          skipped[name + "/" + generatorName + "/" + std::to_string(n) + "/" + std::to_string(degree)] = reason;
+        };
+
+        random_blocks::Xoshiro256x8 rng(config.seed);
+
+        //generate builds into a fresh backend and workspace every call, as a one-shot caller or igraph would.
+        //regenerate rebuilds into the warm ones, the path ensemble::run takes for every replicate after its first.
+        std::unique_ptr<Backend> graph;
+        generators::Workspace    workspace;
+        int64_t                  before = 0;
+        Record                   gen;
+        Record                   regen;
+
+        try {
+          gen = measure(1, [&]() {
+                  graph.reset();
+                  workspace = generators::Workspace{};
+                  rng.seed(config.seed);
+                  before = allocation::live.load();
+                  allocation::peak.store(before);
+                  graph = std::make_unique<Backend>();
+                }, [&]() { generate(*graph, n, degree, rng, workspace); });
+          gen.peak = allocation::peak.load() - before;
+
+          regen = measure(1, [&]() { rng.seed(config.seed); }, [&]() { generate(*graph, n, degree, rng, workspace); });
+        } catch (const std::invalid_argument& e) {
+          skip(e.what());
+          continue;
+        }
+
+        uint64_t E    = graph->getEdgeCount();
+        V             = graph->getVertexCount();
+        if (V == 0) {
+          skip("generated graph is empty");
+          continue;
+        }
+        averageDegree = V ? 2.0 * E / V : 0.0;
+        gen.ops       = std::max<uint64_t>(E, 1);
+        regen.ops     = gen.ops;
+
+        std::vector<uint64_t> endpoints(2 * config.queries);
+        random_blocks::Block<random_blocks::Xoshiro256x8> pick(rng);
+        for (auto& e : endpoints) e = pick.randbelow(V);
+
+        {
+          Backend  copy;
+          uint64_t inserts = std::min(config.inserts, config.queries);
+          push("addEdge", measure(inserts, [&]() { copy = *graph; }, [&]() {
+                 for (uint64_t i = 0; i < inserts; i++) copy.addEdge(endpoints[2 * i], endpoints[2 * i + 1]);
+               }));
+        }
+
+        volatile uint64_t sink = 0;
+
+        push("isConnected", measure(config.queries, [&]() {
+               uint64_t c = 0;
+               for (uint64_t i = 0; i < config.queries; i++) c += graph->isConnected(endpoints[2 * i], endpoints[2 * i + 1]);
+               sink = c;
+             }));
+
+        push("degree", measure(V, [&]() {
+               uint64_t c = 0;
+               for (uint64_t v = 0; v < V; v++) c += graph->getEdgeCount(v);
+               sink = c;
+             }));
+
+        push("edgeCount", measure(1, [&]() { sink = graph->getEdgeCount(); }));
+
+        push("writedisk", measure(1, [&]() { graph->writedisk(persistencePath, io); }));
+        push("readdisk", measure(1, [&]() {
+               Backend loaded;
+               loaded.readdisk(persistencePath, io);
+               sink = loaded.getVertexCount();
+             }));
+
+        //Footprint of a cold build, whatever its destruction gives back. The warm graph also holds clear()'s spare pool
+        graph = std::make_unique<Backend>();
+        rng.seed(config.seed);
+        generate(*graph, n, degree, rng, workspace);
+        int64_t held = allocation::live.load();
+        graph.reset();
+        gen.bytes = held - allocation::live.load();
+        push("generate", gen);
+        push("regenerate", regen);
+      }
+    }
+  }
+
+  std::filesystem::remove(persistencePath);
+}
+
+void printRecord(const Record& r) {
+  std::printf("%-22s %-16s %-12s n=%-7lu k=%-4lu V=%-7lu avg=%-6.2f %12.2f ns/op", r.backend.c_str(), r.generator.c_str(), r.op.c_str(), r.n, r.degree, r.vertices, r.averageDegree, r.nsPerOp());
+  if (r.bytes >= 0) std::printf("  %10ld bytes", r.bytes);
+  std::printf("\n");
+}
+
+void writeJson(const std::string& path, const std::vector<Record>& records) {
+  static const char* counterNames[HardwareCounters::kCount] = {"cycles", "instructions", "cache_misses", "branch_misses"};
+
+  std::ofstream out(path);
+  out << "[\n";
+  for (size_t i = 0; i < records.size(); i++) {
+    const Record& r = records[i];
+    out << "{\"backend\":\"" << r.backend << "\",\"generator\":\"" << r.generator << "\",\"op\":\"" << r.op
+        << "\",\"n\":" << r.n << ",\"degree\":" << r.degree << ",\"vertices\":" << r.vertices
+        << ",\"average_degree\":" << r.averageDegree << ",\"ops\":" << r.ops << ",\"total_ns\":" << r.totalNs
+        << ",\"ns_per_op\":" << r.nsPerOp();
+    if (r.bytes >= 0) out << ",\"bytes\":" << r.bytes << ",\"peak_bytes\":" << r.peak;
+    for (int c = 0; c < HardwareCounters::kCount; c++)
+      if (r.counters[c] >= 0) out << ",\"" << counterNames[c] << "\":" << r.counters[c];
+    out << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+  }
+  out << "]\n";
+}
+
+//Reads back files written by writeJson (and R_benchmarks/test.R), one record object per line
+std::vector<Record> readJson(const std::string& path) {
+  std::vector<Record> records;
+  std::ifstream       in(path);
+  if (!in) {
+    std::cerr << "Unable to open " << path << std::endl;
+    return records;
+  }
+
+  auto field = [](const std::string& line, const std::string& name) -> std::string {
+    size_t p = line.find("\"" + name + "\":");
+    if (p == std::string::npos) return "";
+    p += name.size() + 3;
+    if (line[p] == '"') return line.substr(p + 1, line.find('"', p + 1) - p - 1);
+    return line.substr(p, line.find_first_of(",}", p) - p);
+  };
+
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.find("\"op\"") == std::string::npos) continue;
+    Record r;
+    r.backend   = field(line, "backend");
+    r.generator = field(line, "generator");
+    r.op        = field(line, "op");
+    r.n         = std::strtoull(field(line, "n").c_str(), nullptr, 10);
+    r.degree    = std::strtoull(field(line, "degree").c_str(), nullptr, 10);
+    r.ops       = std::max<uint64_t>(std::strtoull(field(line, "ops").c_str(), nullptr, 10), 1);
+    r.totalNs   = std::strtod(field(line, "total_ns").c_str(), nullptr);
+    if (r.totalNs <= 0) r.totalNs = std::strtod(field(line, "ns_per_op").c_str(), nullptr) * r.ops;
+    records.push_back(r);
+  }
+  return records;
+}
+
+//writedisk/readdisk are still empty in every backend, they are reported but kept out of the gate
+bool gated(const Record& r) {
+  return r.op != "writedisk" && r.op != "readdisk";
+}
+
+//Returns the number of records slower than threshold times the baseline by more than the noise floor per call
+int compare(const std::vector<Record>& records, const std::string& path, const Config& config, bool ignoreBackend) {
+  std::map<std::string, Record> baseline;
+  for (auto& r : readJson(path)) baseline[r.key(!ignoreBackend)] = r;
+
+  std::printf("\n--- %s %s ---\n", ignoreBackend ? "Reference" : "Baseline", path.c_str());
+
+  int regressions = 0;
+  for (auto& r : records) {
+    auto it = baseline.find(r.key(!ignoreBackend));
+    if (it == baseline.end() || it->second.nsPerOp() <= 0) continue;
+
+    const Record& base  = it->second;
+    double        ratio = r.nsPerOp() / base.nsPerOp();
+    bool          slow  = !ignoreBackend && gated(r) && ratio > config.threshold && r.totalNs - base.totalNs > config.noiseFloor;
+    regressions += slow;
+
+    std::printf("%-60s %12.2f vs %12.2f ns/op  x%.2f%s\n", r.key().c_str(), r.nsPerOp(), base.nsPerOp(), ratio,
+                slow ? "  REGRESSION" : (gated(r) ? "" : "  (not gated)"));
+  }
+  return regressions;
+}
+
+std::vector<uint64_t> parseList(const char* arg) {
+  std::vector<uint64_t> values;
+  std::stringstream     s(arg);
+  std::string           item;
+  while (std::getline(s, item, ',')) values.push_back(std::strtoull(item.c_str(), nullptr, 10));
+  return values;
+}
+
+int main(int argc, char** argv) {
+  Config config;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+
+    if (arg.rfind("--", 0) == 0 && arg != "--help" && i + 1 >= argc) {
+      std::cerr << arg << " expects a value" << std::endl;
+      return 1;
+    }
+
+    if (arg == "--sizes") config.sizes = parseList(argv[++i]);
+    else if (arg == "--degrees") config.degrees = parseList(argv[++i]);
+    else if (arg == "--backend") config.backendFilter = argv[++i];
+    else if (arg == "--generator") config.generatorFilter = argv[++i];
+    else if (arg == "--json") config.jsonPath = argv[++i];
+    else if (arg == "--baseline") config.baselinePath = argv[++i];
+    else if (arg == "--reference") config.referencePath = argv[++i];
+    else if (arg == "--threshold") config.threshold = std::strtod(argv[++i], nullptr);
+    else if (arg == "--noise-floor") config.noiseFloor = std::strtod(argv[++i], nullptr);
+    else if (arg == "--queries") config.queries = std::strtoull(argv[++i], nullptr, 10);
+    else if (arg == "--seed") config.seed = std::strtoull(argv[++i], nullptr, 10);
+    else if (arg == "--repetitions") config.repetitions = std::max(1, std::atoi(argv[++i]));
+    else {
+      std::cout << "Usage: " << argv[0] << " [--sizes 1000,10000] [--degrees 6,32] [--backend name] [--generator name]\n"
+                << "       [--json out.json] [--baseline baseline.json] [--threshold 1.25] [--noise-floor 1000]\n"
+                << "       [--reference R_benchmarks/igraph.json]\n"
+                << "       [--queries 100000] [--repetitions 5] [--seed 0]\n";
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  if (!counters.available) std::cout << "Hardware counters unavailable, reporting timings only" << std::endl;
+
+  //Repetitions are whole passes over the sweep rather than back to back samples, so a slow stretch of the machine
+  //cannot hit every sample of one record. Each record keeps its fastest pass.
+  std::vector<Record>                records;
+  std::map<std::string, size_t>      fastest;
+  std::map<std::string, std::string> skipped;
+
+  for (int pass = 0; pass < config.repetitions; pass++) {
+    std::vector<Record> sweep;
+
+    sweepBackend<backends::AdjacencyListVector>("AdjacencyListVector", UINT64_MAX, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyListHash>("AdjacencyListHash", UINT64_MAX, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyListSorted>("AdjacencyListSorted", UINT64_MAX, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyListFlat>("AdjacencyListFlat", 2048, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyMatrix<bool>>("AdjacencyMatrix<bool>", 2048, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyMatrix<char>>("AdjacencyMatrix<char>", 2048, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyMatrixFlat<char>>("AdjacencyMatrixFlat<char>", 2048, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyMatrixRange>("AdjacencyMatrixRange", UINT64_MAX, config, sweep, skipped);
+    sweepBackend<backends::AdjacencyMatrixHash>("AdjacencyMatrixHash", 2048, config, sweep, skipped);
+
+    for (auto& r : sweep) {
+      auto [it, inserted] = fastest.try_emplace(r.key(), records.size());
+      if (inserted) records.push_back(r);
+      else if (r.totalNs < records[it->second].totalNs) records[it->second] = r;
+    }
+  }
+
+  for (auto& r : records) printRecord(r);
+  for (auto& [key, reason] : skipped) std::printf("%-60s skipped: %s\n", key.c_str(), reason.c_str());
+
+  if (!config.jsonPath.empty()) writeJson(config.jsonPath, records);
+
+  int regressions = 0;
+  if (!config.baselinePath.empty()) regressions = compare(records, config.baselinePath, config, false);
+  if (!config.referencePath.empty()) compare(records, config.referencePath, config, true);
+
+  if (regressions > 0) {
+    std::cout << regressions << " regressions above x" << config.threshold << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include "generators.hpp"
+#include "randomblocks.hpp"
+#include "profiling.hpp"
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace graphs {
+
+namespace ensemble {
+
+//Sum over replicates of how many vertices have each out degree
+struct DegreeHistogram {
+  std::vector<uint64_t> counts;
+  uint64_t              replicates = 0;
+
+  template <typename GraphT>
+  void add(const GraphT& graph) {
+    uint64_t N = graph.getVertexCount();
+    for (uint64_t v = 0; v < N; v++) {
+      uint64_t d = graph.getEdgeCount(v);
+      if (d >= counts.size()) counts.resize(d + 1, 0);
+      counts[d]++;
+    }
+    replicates++;
+  }
+
+  void merge(const DegreeHistogram& other) {
+    if (other.counts.size() > counts.size()) counts.resize(other.counts.size(), 0);
+    for (size_t d = 0; d < other.counts.size(); d++) counts[d] += other.counts[d];
+    replicates += other.replicates;
+  }
+
+  //Expected number of vertices with degree d in a single replicate
+  std::vector<double> mean() const {
+    std::vector<double> result(counts.size());
+    for (size_t d = 0; d < counts.size(); d++) result[d] = replicates ? double(counts[d]) / replicates : 0.0;
+    return result;
+  }
+};
+
+//Sums are kept as exact integers so merging is associative and the result does not depend on merge order
+struct EdgeCount {
+  uint64_t          replicates = 0;
+  uint64_t          sum        = 0;
+  unsigned __int128 sumSquares = 0;
+
+  template <typename GraphT>
+  void add(const GraphT& graph) {
+    uint64_t e = graph.getEdgeCount();
+    sum += e;
+    sumSquares += (unsigned __int128)e * e;
+    replicates++;
+  }
+
+  void merge(const EdgeCount& other) {
+    replicates += other.replicates;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+  }
+
+  double mean() const { return replicates ? double(sum) / replicates : 0.0; }
+
+  //n * sum(x^2) - sum(x)^2 is formed exactly before the single rounding, avoiding E[x^2] - mean^2 cancellation
+  double variance() const {
+    if (!replicates) return 0.0;
+    unsigned __int128 spread = replicates * sumSquares - (unsigned __int128)sum * sum;
+    return double(spread) / (double(replicates) * double(replicates));
+  }
+};
+
+//Groups several accumulators so they are fed and merged together
+template <typename... Metrics>
+struct MetricSet {
+  std::tuple<Metrics...> metrics;
+
+  template <typename GraphT>
+  void add(const GraphT& graph) {
+    std::apply([&](auto&... m) { (m.add(graph), ...); }, metrics);
+  }
+
+  void merge(const MetricSet& other) {
+    merge(other, std::index_sequence_for<Metrics...>{});
+  }
+
+  template <typename Metric>
+  const Metric& get() const { return std::get<Metric>(metrics); }
+
+private:
+  template <size_t... I>
+  void merge(const MetricSet& other, std::index_sequence<I...>) {
+    (std::get<I>(metrics).merge(std::get<I>(other.metrics)), ...);
+  }
+};
+
+//Callback that ignores intermediate aggregates
+struct NoProgress {
+  template <typename Metrics>
+  void operator()(const Metrics&, uint64_t) const {}
+};
+
+//Runs `replicates` independent generations and folds each graph into `metrics` without keeping it alive.
+//Metrics must be default constructible, expose add(const GraphT&) and merge(const Metrics&).
+//
+//generate(GraphT& g, random_blocks::Xoshiro256x8& rng, generators::Workspace& workspace) must rebuild g, e.g. through
+//the in place generator overloads. Replicates are handed out one at a time with OpenMP dynamic scheduling so idle
+//threads pick up the remaining work, every thread owns one graph, one workspace and one accumulator reused across
+//replicates and released when run returns. Partial aggregates are merged into the shared result every `flushEvery`
+//replicates and passed to onProgress(aggregate, completed) under a lock.
+//The first exception thrown by generate, a metric or onProgress stops the remaining replicates and is rethrown here.
+//Replicate r is always seeded from (seed, r), so metrics whose merge is exact (DegreeHistogram, EdgeCount) give the
+//same aggregate for any thread count. Floating point accumulators may differ in rounding with the merge order.
+template <typename GraphT, typename Generator, typename Metrics, typename Progress = NoProgress>
+Metrics run(uint64_t  replicates,
+            Generator generate,
+            Metrics   metrics,
+            uint64_t  seed       = 0,
+            uint64_t  flushEvery = 64,
+            Progress  onProgress = Progress{}) {
+  DETRA_ZONE("ensemble::run");
+  std::mutex         lock;
+  uint64_t           completed = 0;
+  std::exception_ptr failure;
+  std::atomic<bool>  failed{false};
+
+  //Exceptions cannot leave an OpenMP region, the first one is kept and the rest of the work is skipped
+  auto guarded = [&](auto&& f) {
+    try {
+      f();
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!failure) failure = std::current_exception();
+      failed.store(true, std::memory_order_relaxed);
+    }
+  };
+
+#pragma omp parallel
+  {
+    GraphT                      graph;
+    generators::Workspace       workspace;
+    Metrics                     local;
+    random_blocks::Xoshiro256x8 rng;
+    uint64_t                    pending = 0;
+
+    auto flush = [&]() {
+      std::lock_guard<std::mutex> guard(lock);
+      metrics.merge(local);
+      completed += pending;
+      onProgress(static_cast<const Metrics&>(metrics), completed);
+      local   = Metrics{};
+      pending = 0;
+    };
+
+#pragma omp for schedule(dynamic, 1) nowait
+    for (int64_t r = 0; r < int64_t(replicates); r++) {
+      if (failed.load(std::memory_order_relaxed)) continue;
+
+      guarded([&]() {
+        DETRA_ZONE("ensemble::replicate");
+        uint64_t state = seed ^ (uint64_t(r) * 0xD1B54A32D192ED03ull);
+        rng.seed(random_blocks::splitmix64(state));
+
+        generate(graph, rng, workspace);
+        local.add(graph);
+
+        if (++pending == flushEvery) flush();
+      });
+    }
+
+    if (pending > 0 && !failed.load(std::memory_order_relaxed)) guarded(flush);
+  }
+
+  if (failure) std::rethrow_exception(failure);
+  return metrics;
+}
+
+} // namespace ensemble
+} // namespace graphs
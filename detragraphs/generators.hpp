@@ -1,36 +1,67 @@
+#pragma once
 #include <unordered_set>
 #include <detrarandom/random_sources.hpp>
+#include "randomblocks.hpp"
+#include "profiling.hpp"
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 namespace graphs {
 namespace generators {
+
+//Every generator has two forms: one returning a fresh graph, and one rebuilding into an existing graph through
+//clear() so repeated generation (see ensemble.hpp) reuses backend storage. Generators that need scratch space take
+//it from a Workspace owned by the caller, so it is kept between replicates and freed with it.
+struct Workspace {
+  std::vector<uint64_t> degreeList;
+  std::vector<uint64_t> targets;
+  std::vector<uint64_t> preferentialNodes;
+  std::vector<uint64_t> currentLevel;
+  std::vector<uint64_t> nextLevel;
+};
+
 template <typename GraphT, typename RandomSource>
+void erdos_renyi_undirected(GraphT& g, uint64_t n, double p, RandomSource& randomSource) {
+  DETRA_ZONE("generators::erdos_renyi_undirected");
+  random_blocks::Block<RandomSource> rng(randomSource);
 
-GraphT erdos_renyi_undirected(uint64_t n, double p, RandomSource randomSource = RandomSource{}) {
-  GraphT g;
+  g.clear();
   g.addVertices(n);
 
   for (uint64_t i = 0; i < n; ++i) {
     for (uint64_t j = i + 1; j < n; ++j) {
-      if (i != j && randomSource.randb()) {
+      if (i != j && rng.randd() < p) {
         g.addEdge(j, i);
       }
     }
   }
+}
+
+template <typename GraphT, typename RandomSource>
+GraphT erdos_renyi_undirected(uint64_t n, double p, RandomSource randomSource = RandomSource{}) {
+  GraphT g;
+  erdos_renyi_undirected(g, n, p, randomSource);
   return g;
 }
 
 template <typename GraphT, typename RandomSource>
-GraphT barabasi_albert_undirected(uint64_t n, uint64_t m0, uint64_t m, RandomSource randomSource = RandomSource{}) {
+void barabasi_albert_undirected(GraphT& g, uint64_t n, uint64_t m0, uint64_t m, RandomSource& randomSource, Workspace& workspace) {
+  DETRA_ZONE("generators::barabasi_albert_undirected");
   if (m > m0 || m0 >= n) throw std::invalid_argument("Invalid parameters for BA model");
 
-  GraphT g;
+  random_blocks::Block<RandomSource> rng(randomSource);
+
+  g.clear();
   g.addVertices(m0);
 
   for (uint64_t i = 0; i < m0; ++i)
     for (uint64_t j = i + 1; j < m0; ++j)
       if (i != j) g.addEdge(j, i);
 
-  std::vector<uint64_t> degreeList;
+  auto& degreeList = workspace.degreeList;
+  auto& targets    = workspace.targets;
+  degreeList.clear();
+
   for (uint64_t i = 0; i < m0; ++i)
     for (uint64_t d = 0; d < g.getVertexCount(); ++d)
       degreeList.push_back(i);
@@ -38,11 +69,11 @@ GraphT barabasi_albert_undirected(uint64_t n, uint64_t m0, uint64_t m, RandomSou
   g.addVertices(n - m0);
 
   for (uint64_t i = m0; i < n; ++i) {
-    std::unordered_set<uint64_t> targets;
+    targets.clear();
 
     while (targets.size() < m) {
-      uint64_t chosen = degreeList[randomSource.randi() % (degreeList.size())];
-      if (chosen != i) targets.insert(chosen);
+      uint64_t chosen = degreeList[rng.randbelow(degreeList.size())];
+      if (chosen != i && std::find(targets.begin(), targets.end(), chosen) == targets.end()) targets.push_back(chosen);
     }
 
     for (uint64_t t : targets) {
@@ -51,15 +82,24 @@ GraphT barabasi_albert_undirected(uint64_t n, uint64_t m0, uint64_t m, RandomSou
       degreeList.push_back(i);
     }
   }
+}
 
+template <typename GraphT, typename RandomSource>
+GraphT barabasi_albert_undirected(uint64_t n, uint64_t m0, uint64_t m, RandomSource randomSource = RandomSource{}) {
+  GraphT    g;
+  Workspace workspace;
+  barabasi_albert_undirected(g, n, m0, m, randomSource, workspace);
   return g;
 }
 
 template <typename GraphT, typename RandomSource>
-GraphT watts_strogatz_undirected(uint64_t n, uint64_t k, double beta, RandomSource randomSource = RandomSource{}) {
+void watts_strogatz_undirected(GraphT& g, uint64_t n, uint64_t k, double beta, RandomSource& randomSource) {
+  DETRA_ZONE("generators::watts_strogatz_undirected");
   if (k >= n) throw std::invalid_argument("k must be < n");
 
-  GraphT g;
+  random_blocks::Block<RandomSource> rng(randomSource);
+
+  g.clear();
   g.addVertices(n);
 
   for (uint64_t i = 0; i < n; ++i)
@@ -69,59 +109,78 @@ GraphT watts_strogatz_undirected(uint64_t n, uint64_t k, double beta, RandomSour
   for (uint64_t i = 0; i < n; ++i) {
     for (uint64_t j = 1; j <= k; ++j) {
       uint64_t neighbor = (i + j) % n;
-      if (randomSource.randf() < beta) {
+      if (rng.randf() < beta) {
         uint64_t newNeighbor;
         do {
-          newNeighbor = randomSource.randi() % n;
+          newNeighbor = rng.randbelow(n);
         } while (newNeighbor == i || g.isConnected(i, newNeighbor));
         g.addEdge(i, newNeighbor);
       }
     }
   }
+}
 
+template <typename GraphT, typename RandomSource>
+GraphT watts_strogatz_undirected(uint64_t n, uint64_t k, double beta, RandomSource randomSource = RandomSource{}) {
+  GraphT g;
+  watts_strogatz_undirected(g, n, k, beta, randomSource);
   return g;
 }
 
 //Relaxed version of barabasi albert, faster to compute while retaining power scaling nature
 //TODO: Prevent double edge addition
 template <typename GraphT, typename RandomSource>
-GraphT prefferential_directed(uint64_t n, uint64_t e, RandomSource randomSource = RandomSource{}) {
-  GraphT g;
+void prefferential_directed(GraphT& g, uint64_t n, uint64_t e, RandomSource& randomSource, Workspace& workspace) {
+  DETRA_ZONE("generators::prefferential_directed");
+  random_blocks::Block<RandomSource> rng(randomSource);
+
+  g.clear();
   g.addVertices(n);
 
-  std::vector<uint64_t> preferentialNodes(n);
+  auto& preferentialNodes = workspace.preferentialNodes;
+  preferentialNodes.resize(n);
   for (int i = 0; i < preferentialNodes.size(); i++)
     preferentialNodes[i] = i;
 
   for (int i = 0; i < e; i++) {
     int u = i % n;
-    int v = preferentialNodes[randomSource.randi() % preferentialNodes.size()];
+    int v = preferentialNodes[rng.randbelow(preferentialNodes.size())];
     if (u != v) {
       g.addEdge(v, u);
       preferentialNodes.push_back(v);
     }
   }
+}
 
+template <typename GraphT, typename RandomSource>
+GraphT prefferential_directed(uint64_t n, uint64_t e, RandomSource randomSource = RandomSource{}) {
+  GraphT    g;
+  Workspace workspace;
+  prefferential_directed(g, n, e, randomSource, workspace);
   return g;
 }
 
 template <typename GraphT, typename RandomSource>
-GraphT recursive_tree(uint64_t levels, uint64_t maxlevelcount, float p, RandomSource randomSource = RandomSource{}) {
-  GraphT g;
-  if (levels == 0) return g;
+void recursive_tree(GraphT& g, uint64_t levels, uint64_t maxlevelcount, float p, RandomSource& randomSource, Workspace& workspace) {
+  DETRA_ZONE("generators::recursive_tree");
+  random_blocks::Block<RandomSource> rng(randomSource);
+
+  g.clear();
+  if (levels == 0) return;
 
   g.addVertices(1);
 
-  std::vector<uint64_t> currentLevel = {0};
-  uint64_t              nextVertex   = 1;
+  auto& currentLevel = workspace.currentLevel;
+  auto& nextLevel    = workspace.nextLevel;
+  currentLevel.assign(1, 0);
+  uint64_t nextVertex = 1;
 
   for (uint64_t level = 1; level < levels; ++level) {
-    std::vector<uint64_t> nextLevel;
+    nextLevel.clear();
 
     for (uint64_t parent : currentLevel) {
       for (uint64_t i = 0; i < maxlevelcount; ++i) {
-        float r = randomSource.randi() / float(std::numeric_limits<uint32_t>::max());
-        if (r < p) {
+        if (rng.randf() < p) {
           g.addVertices(1);
           g.addEdge(parent, nextVertex);
           nextLevel.push_back(nextVertex);
@@ -131,9 +190,15 @@ GraphT recursive_tree(uint64_t levels, uint64_t maxlevelcount, float p, RandomSo
     }
 
     if (nextLevel.empty()) break;
-    currentLevel = std::move(nextLevel);
+    std::swap(currentLevel, nextLevel);
   }
+}
 
+template <typename GraphT, typename RandomSource>
+GraphT recursive_tree(uint64_t levels, uint64_t maxlevelcount, float p, RandomSource randomSource = RandomSource{}) {
+  GraphT    g;
+  Workspace workspace;
+  recursive_tree(g, levels, maxlevelcount, p, randomSource, workspace);
   return g;
 }
 
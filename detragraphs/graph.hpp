@@ -22,6 +22,14 @@ struct Graph {
     return data.isConnected(from, to);
   }
   inline void addVertices(uint64_t vertices) { data.addVertices(vertices); }
+  inline void clear() { data.clear(); }
+
+  template <typename F>
+  inline void forEachNeighbor(uint64_t vertex, F&& f) const { data.forEachNeighbor(vertex, std::forward<F>(f)); }
+
+  template <typename F>
+    requires requires(const Backend& b, F&& f) { b.forEachEdge(std::forward<F>(f)); }
+  inline void forEachEdge(F&& f) const { data.forEachEdge(std::forward<F>(f)); }
 
   inline void writedisk(const std::string& path, std::shared_ptr<detra::IOAdapter> io = detra::unisIO()) {
     data.writedisk(path, io);
@@ -5,13 +5,18 @@
 #include <string>
 #include <algorithm>
 #include "../ioadapter.hpp"
+#include "../profiling.hpp"
 #include <iostream>
 
 namespace graphs {
 
 namespace backends {
 struct AdjacencyListVector {
-  std::vector<std::vector<uint64_t>> adj;
+  DETRA_MEMORY_TAG(AdjacencyListVector);
+  using Row = detra::profiling::TrackedVector<uint64_t, MemoryTag>;
+
+  detra::profiling::TrackedVector<Row, MemoryTag> adj;
+  detra::profiling::TrackedVector<Row, MemoryTag> spare;
 
   uint64_t getVertexCount() const { return adj.size(); }
   uint64_t getEdgeCount() const {
@@ -23,19 +28,47 @@ struct AdjacencyListVector {
 
   void addEdge(uint64_t from, uint64_t to) {
     if (from == to) return;
-    if (std::find(adj[from].begin(), adj[from].end(), to) == adj[from].end())
+    if (std::find(adj[from].begin(), adj[from].end(), to) == adj[from].end()) {
       adj[from].push_back(to);
+      DETRA_COUNT("edges inserted", 1);
+    } else {
+      DETRA_COUNT("duplicate edges rejected", 1);
+    }
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
     return std::find(adj[from].begin(), adj[from].end(), to) != adj[from].end();
   }
 
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    for (uint64_t u : adj[v]) f(u);
+  }
+
   void writedisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
   void readdisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
   void addVertices(uint64_t vertices) {
-    adj.resize(adj.size() + vertices, {});
+    DETRA_ZONE("AdjacencyListVector::addVertices");
+    for (uint64_t i = 0; i < vertices; ++i) {
+      if (spare.empty()) {
+        adj.emplace_back();
+      } else {
+        adj.push_back(std::move(spare.back()));
+        spare.pop_back();
+      }
+    }
+  }
+
+  //Keeps the emptied adjacency rows around so the next addVertices reuses their capacity
+  void clear() {
+    DETRA_ZONE("AdjacencyListVector::clear");
+    spare.reserve(spare.size() + adj.size());
+    for (auto it = adj.rbegin(); it != adj.rend(); ++it) {
+      it->clear();
+      spare.push_back(std::move(*it));
+    }
+    adj.clear();
   }
 
   void print() {
@@ -51,7 +84,11 @@ struct AdjacencyListVector {
 };
 
 struct AdjacencyListHash {
-  std::vector<std::unordered_set<uint64_t>> adj;
+  DETRA_MEMORY_TAG(AdjacencyListHash);
+  using Row = detra::profiling::TrackedUnorderedSet<uint64_t, MemoryTag>;
+
+  detra::profiling::TrackedVector<Row, MemoryTag> adj;
+  detra::profiling::TrackedVector<Row, MemoryTag> spare;
 
   uint64_t getVertexCount() const { return adj.size(); }
   uint64_t getEdgeCount() const {
@@ -59,29 +96,59 @@ struct AdjacencyListHash {
     for (auto& v : adj) c += v.size();
     return c;
   }
-  uint64_t getEdgeCount(uint64_t v) { return adj[v].size(); }
+  uint64_t getEdgeCount(uint64_t v) const { return adj[v].size(); }
 
   void addEdge(uint64_t from, uint64_t to) {
     if (from == to) return;
-    adj[from].insert(to);
+    if (adj[from].insert(to).second)
+      DETRA_COUNT("edges inserted", 1);
+    else
+      DETRA_COUNT("duplicate edges rejected", 1);
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
     return adj[from].count(to) > 0;
   }
 
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    for (uint64_t u : adj[v]) f(u);
+  }
+
   void writedisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
   void readdisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
   void addVertices(uint64_t vertices) {
-    adj.resize(adj.size() + vertices);
+    DETRA_ZONE("AdjacencyListHash::addVertices");
+    for (uint64_t i = 0; i < vertices; ++i) {
+      if (spare.empty()) {
+        adj.emplace_back();
+      } else {
+        adj.push_back(std::move(spare.back()));
+        spare.pop_back();
+      }
+    }
+  }
+
+  void clear() {
+    DETRA_ZONE("AdjacencyListHash::clear");
+    spare.reserve(spare.size() + adj.size());
+    for (auto it = adj.rbegin(); it != adj.rend(); ++it) {
+      it->clear();
+      spare.push_back(std::move(*it));
+    }
+    adj.clear();
   }
 
   void print() {}
 };
 
 struct AdjacencyListSorted {
-  std::vector<std::vector<uint64_t>> adj;
+  DETRA_MEMORY_TAG(AdjacencyListSorted);
+  using Row = detra::profiling::TrackedVector<uint64_t, MemoryTag>;
+
+  detra::profiling::TrackedVector<Row, MemoryTag> adj;
+  detra::profiling::TrackedVector<Row, MemoryTag> spare;
 
   uint64_t getVertexCount() const { return adj.size(); }
   uint64_t getEdgeCount() const {
@@ -89,13 +156,18 @@ struct AdjacencyListSorted {
     for (auto& v : adj) c += v.size();
     return c;
   }
-  uint64_t getEdgeCount(uint64_t v) { return adj[v].size(); }
+  uint64_t getEdgeCount(uint64_t v) const { return adj[v].size(); }
 
   void addEdge(uint64_t from, uint64_t to) {
     if (from == to) return;
     auto& vec = adj[from];
     auto  it  = std::lower_bound(vec.begin(), vec.end(), to);
-    if (it == vec.end() || *it != to) vec.insert(it, to);
+    if (it == vec.end() || *it != to) {
+      vec.insert(it, to);
+      DETRA_COUNT("edges inserted", 1);
+    } else {
+      DETRA_COUNT("duplicate edges rejected", 1);
+    }
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
@@ -103,19 +175,44 @@ struct AdjacencyListSorted {
     return std::binary_search(vec.begin(), vec.end(), to);
   }
 
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    for (uint64_t u : adj[v]) f(u);
+  }
+
   void writedisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
   void readdisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
   void addVertices(uint64_t vertices) {
-    adj.resize(adj.size() + vertices, {});
+    DETRA_ZONE("AdjacencyListSorted::addVertices");
+    for (uint64_t i = 0; i < vertices; ++i) {
+      if (spare.empty()) {
+        adj.emplace_back();
+      } else {
+        adj.push_back(std::move(spare.back()));
+        spare.pop_back();
+      }
+    }
+  }
+
+  void clear() {
+    DETRA_ZONE("AdjacencyListSorted::clear");
+    spare.reserve(spare.size() + adj.size());
+    for (auto it = adj.rbegin(); it != adj.rend(); ++it) {
+      it->clear();
+      spare.push_back(std::move(*it));
+    }
+    adj.clear();
   }
 
   void print() {}
 };
 
 struct AdjacencyListFlat {
-  std::vector<uint64_t> edges;
-  std::vector<size_t>   offsets; // offsets[i] = start of vertex i's edges
+  DETRA_MEMORY_TAG(AdjacencyListFlat);
+
+  detra::profiling::TrackedVector<uint64_t, MemoryTag> edges;
+  detra::profiling::TrackedVector<size_t, MemoryTag>   offsets; // offsets[i] = start of vertex i's edges
 
   uint64_t getVertexCount() const { return offsets.size(); }
 
@@ -131,8 +228,14 @@ struct AdjacencyListFlat {
 
   void addEdge(uint64_t from, uint64_t to) {
     if (from >= offsets.size() || from == to) return;
-    edges.insert(edges.begin() + offsets[from + 1], to); // simplistic, real impl may require shift
+    size_t end = (from + 1 < offsets.size()) ? offsets[from + 1] : edges.size();
+    if (std::find(edges.begin() + offsets[from], edges.begin() + end, to) != edges.begin() + end) {
+      DETRA_COUNT("duplicate edges rejected", 1);
+      return;
+    }
+    edges.insert(edges.begin() + end, to); // simplistic, real impl may require shift
     for (size_t i = from + 1; i < offsets.size(); ++i) offsets[i]++;
+    DETRA_COUNT("edges inserted", 1);
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
@@ -142,13 +245,27 @@ struct AdjacencyListFlat {
     return std::find(edges.begin() + start, edges.begin() + end, to) != edges.begin() + end;
   }
 
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    if (v >= offsets.size()) return;
+    size_t end = (v + 1 < offsets.size()) ? offsets[v + 1] : edges.size();
+    for (size_t i = offsets[v]; i < end; ++i) f(edges[i]);
+  }
+
   void writedisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
   void readdisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
   void addVertices(uint64_t vertices) {
+    DETRA_ZONE("AdjacencyListFlat::addVertices");
     size_t old = offsets.size();
     offsets.resize(old + vertices, edges.size());
   }
+
+  void clear() {
+    DETRA_ZONE("AdjacencyListFlat::clear");
+    edges.clear();
+    offsets.clear();
+  }
   void print() {
   }
 };
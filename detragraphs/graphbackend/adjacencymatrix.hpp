@@ -1,9 +1,11 @@
 #pragma once
 #include <vector>
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <unordered_set>
 #include "../ioadapter.hpp"
+#include "../profiling.hpp"
 #include <iostream>
 
 namespace graphs {
@@ -12,7 +14,11 @@ namespace backends {
 
 template <typename edgeType = bool>
 struct AdjacencyMatrix {
-  std::vector<std::vector<edgeType>> mat;
+  DETRA_MEMORY_TAG_OF(AdjacencyMatrix, edgeType);
+  using Row = detra::profiling::TrackedVector<edgeType, MemoryTag>;
+
+  detra::profiling::TrackedVector<Row, MemoryTag> mat;
+  detra::profiling::TrackedVector<Row, MemoryTag> spare;
 
   uint64_t getVertexCount() const { return mat.size(); }
 
@@ -26,28 +32,60 @@ struct AdjacencyMatrix {
 
   uint64_t getEdgeCount(uint64_t vertex) const {
     uint64_t c = 0;
-    for (auto& e : mat[vertex])
+    for (auto e : mat[vertex])
       if (e) ++c;
     return c;
   }
 
   void addEdge(uint64_t from, uint64_t to) {
     if (from == to) return;
+    if (mat[from][to]) {
+      DETRA_COUNT("duplicate edges rejected", 1);
+      return;
+    }
     mat[from][to] = true;
+    DETRA_COUNT("edges inserted", 1);
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
     return mat[from][to];
   }
 
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    const auto& row = mat[v];
+    for (uint64_t u = 0; u < row.size(); ++u)
+      if (row[u]) f(u);
+  }
+
   void writedisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
   void readdisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
   void addVertices(uint64_t vertices) {
-    size_t old_size = mat.size();
-    for (auto& row : mat) row.resize(old_size + vertices);
-    mat.resize(old_size + vertices, std::vector<edgeType>(old_size + vertices));
+    DETRA_ZONE("AdjacencyMatrix::addVertices");
+    size_t size = mat.size() + vertices;
+    for (auto& row : mat) row.resize(size);
+    for (uint64_t i = 0; i < vertices; ++i) {
+      if (spare.empty()) {
+        mat.emplace_back(size);
+      } else {
+        mat.push_back(std::move(spare.back()));
+        spare.pop_back();
+        mat.back().resize(size);
+      }
+    }
+  }
+
+  //Rows are emptied, not freed, and handed back by addVertices
+  void clear() {
+    DETRA_ZONE("AdjacencyMatrix::clear");
+    spare.reserve(spare.size() + mat.size());
+    for (auto it = mat.rbegin(); it != mat.rend(); ++it) {
+      it->clear();
+      spare.push_back(std::move(*it));
+    }
+    mat.clear();
   }
 
   void print() {
@@ -64,7 +102,9 @@ struct AdjacencyMatrix {
 
 template <typename edgeType = bool>
 struct AdjacencyMatrixFlat {
-  std::vector<edgeType> mat;
+  DETRA_MEMORY_TAG_OF(AdjacencyMatrixFlat, edgeType);
+
+  detra::profiling::TrackedVector<edgeType, MemoryTag> mat;
 
   size_t N = 0;
 
@@ -87,24 +127,46 @@ struct AdjacencyMatrixFlat {
 
   void addEdge(uint64_t from, uint64_t to) {
     if (from == to) return;
+    if (mat[from * N + to]) {
+      DETRA_COUNT("duplicate edges rejected", 1);
+      return;
+    }
     mat[from * N + to] = true;
+    DETRA_COUNT("edges inserted", 1);
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
     return mat[from * N + to];
   }
 
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    size_t start = v * N;
+    for (uint64_t u = 0; u < N; ++u)
+      if (mat[start + u]) f(u);
+  }
+
   void writedisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
   void readdisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
   void addVertices(uint64_t vertices) {
+    DETRA_ZONE("AdjacencyMatrixFlat::addVertices");
     size_t oldN = N;
     N += vertices;
-    std::vector<edgeType> newMat(N * N, 0);
-    for (size_t i = 0; i < oldN; ++i)
-      for (size_t j = 0; j < oldN; ++j)
-        newMat[i * N + j] = mat[i * oldN + j];
-    mat = std::move(newMat);
+    mat.resize(N * N, 0);
+
+    //Widen rows in place, last row first so no source row is overwritten before it moves
+    for (size_t i = oldN; i-- > 0;) {
+      std::copy_backward(mat.begin() + i * oldN, mat.begin() + (i + 1) * oldN, mat.begin() + i * N + oldN);
+      std::fill(mat.begin() + i * N + oldN, mat.begin() + (i + 1) * N, 0);
+    }
+  }
+
+  //Keeps mat's capacity, the next addVertices from N = 0 refills it without allocating
+  void clear() {
+    DETRA_ZONE("AdjacencyMatrixFlat::clear");
+    mat.clear();
+    N = 0;
   }
 
   void print() {
@@ -120,12 +182,34 @@ struct AdjacencyMatrixFlat {
 };
 
 struct AdjacencyMatrixRange {
-  std::vector<std::vector<std::pair<uint64_t, uint64_t>>> ranges;
+  DETRA_MEMORY_TAG(AdjacencyMatrixRange);
+  using Row = detra::profiling::TrackedVector<std::pair<uint64_t, uint64_t>, MemoryTag>;
+
+  detra::profiling::TrackedVector<Row, MemoryTag> ranges;
+  detra::profiling::TrackedVector<Row, MemoryTag> spare;
 
   uint64_t getVertexCount() const { return ranges.size(); }
 
   void addVertices(uint64_t vertices) {
-    ranges.resize(ranges.size() + vertices, {});
+    DETRA_ZONE("AdjacencyMatrixRange::addVertices");
+    for (uint64_t i = 0; i < vertices; ++i) {
+      if (spare.empty()) {
+        ranges.emplace_back();
+      } else {
+        ranges.push_back(std::move(spare.back()));
+        spare.pop_back();
+      }
+    }
+  }
+
+  void clear() {
+    DETRA_ZONE("AdjacencyMatrixRange::clear");
+    spare.reserve(spare.size() + ranges.size());
+    for (auto it = ranges.rbegin(); it != ranges.rend(); ++it) {
+      it->clear();
+      spare.push_back(std::move(*it));
+    }
+    ranges.clear();
   }
 
   void addEdge(uint64_t from, uint64_t to) {
@@ -135,6 +219,7 @@ struct AdjacencyMatrixRange {
       vec.back().second = to; // extend last range
     else
       vec.emplace_back(to, to);
+    DETRA_COUNT("edges inserted", 1);
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
@@ -144,6 +229,12 @@ struct AdjacencyMatrixRange {
     return false;
   }
 
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    for (auto& r : ranges[v])
+      for (uint64_t u = r.first; u <= r.second; ++u) f(u);
+  }
+
   uint64_t getEdgeCount() const {
     uint64_t c = 0;
     for (auto& row : ranges)
@@ -186,7 +277,9 @@ struct AdjacencyMatrixHash {
     }
   };
 
-  std::unordered_set<std::pair<uint64_t, uint64_t>, pair_hash, std::equal_to<>> edges;
+  DETRA_MEMORY_TAG(AdjacencyMatrixHash);
+
+  detra::profiling::TrackedUnorderedSet<std::pair<uint64_t, uint64_t>, MemoryTag, pair_hash, std::equal_to<>> edges;
 
   size_t N = 0;
 
@@ -202,17 +295,41 @@ struct AdjacencyMatrixHash {
 
   void addEdge(uint64_t from, uint64_t to) {
     if (from == to) return;
-    edges.emplace(from, to);
+    if (edges.emplace(from, to).second)
+      DETRA_COUNT("edges inserted", 1);
+    else
+      DETRA_COUNT("duplicate edges rejected", 1);
   }
 
   bool isConnected(uint64_t from, uint64_t to) const {
     return edges.find({from, to}) != edges.end();
   }
 
+  //Scans every edge, callers visiting the whole graph should go through forEachEdge instead
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    for (auto& e : edges)
+      if (e.first == v) f(e.second);
+  }
+
+  template <typename F>
+  void forEachEdge(F&& f) const {
+    for (auto& e : edges) f(e.first, e.second);
+  }
+
   void writedisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
   void readdisk(const std::string&, std::shared_ptr<detra::IOAdapter>) {}
 
-  void addVertices(uint64_t vertices) { N += vertices; }
+  void addVertices(uint64_t vertices) {
+    DETRA_ZONE("AdjacencyMatrixHash::addVertices");
+    N += vertices;
+  }
+
+  void clear() {
+    DETRA_ZONE("AdjacencyMatrixHash::clear");
+    edges.clear();
+    N = 0;
+  }
 
   void print() {
     std::cout << "---AdjacencyMatrixHash---" << std::endl;
@@ -4,6 +4,9 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <cerrno>
+#include <string>
+#include "profiling.hpp"
 
 namespace detra {
 struct IOAdapter {
@@ -30,6 +33,7 @@ struct IOAdapterUnis : public IOAdapter {
   }
 
   inline ssize_t read(int fd, void* buffer, size_t length) override {
+    DETRA_ZONE("IOAdapterUnis::read");
     size_t total = 0;
     auto*  ptr   = static_cast<char*>(buffer);
 
@@ -43,10 +47,12 @@ struct IOAdapterUnis : public IOAdapter {
       if (r == 0) break; // EOF
       total += r;
     }
+    DETRA_COUNT("bytes read", total);
     return total;
   }
 
   inline ssize_t write(int fd, const void* buffer, size_t length) override {
+    DETRA_ZONE("IOAdapterUnis::write");
     size_t total = 0;
     auto*  ptr   = static_cast<const char*>(buffer);
 
@@ -59,10 +65,14 @@ struct IOAdapterUnis : public IOAdapter {
       }
       total += w;
     }
+    DETRA_COUNT("bytes written", total);
     return total;
   }
 
-  inline int flush(int fd) override { return ::fsync(fd); }
+  inline int flush(int fd) override {
+    DETRA_ZONE("IOAdapterUnis::flush");
+    return ::fsync(fd);
+  }
   inline int close(int fd) override { return ::close(fd); }
 
   ~IOAdapterUnis() override = default;
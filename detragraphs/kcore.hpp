@@ -0,0 +1,179 @@
+#pragma once
+#include "metrics.hpp"
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace graphs {
+
+namespace metrics {
+
+struct CoreDecomposition {
+  std::vector<uint32_t> core;      // core[v] = largest k such that v belongs to the k-core
+  std::vector<uint64_t> ordering;  // vertices in removal order, each has at most `degeneracy` later neighbors
+  uint32_t              degeneracy = 0;
+};
+
+//Undirected CSR snapshot of any backend exposing forEachNeighbor, both edge directions merged and deduplicated.
+//Backends that cannot enumerate one vertex cheaply (AdjacencyMatrixHash) expose forEachEdge(f(from, to)) and are
+//walked once in a single pass instead.
+struct SymmetricAdjacency {
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> neighbors;
+  std::vector<uint32_t> degree;
+
+  template <typename GraphT>
+  explicit SymmetricAdjacency(const GraphT& graph) {
+    DETRA_ZONE("metrics::SymmetricAdjacency");
+    constexpr bool edgeWalk = requires { graph.forEachEdge([](uint64_t, uint64_t) {}); };
+    int64_t        N        = graph.getVertexCount();
+
+    std::vector<std::atomic<uint64_t>> cursor(N);
+
+    if constexpr (edgeWalk) {
+      graph.forEachEdge([&](uint64_t v, uint64_t u) {
+        cursor[v].fetch_add(1, std::memory_order_relaxed);
+        cursor[u].fetch_add(1, std::memory_order_relaxed);
+      });
+    } else {
+#pragma omp parallel for schedule(dynamic, 1024)
+      for (int64_t v = 0; v < N; v++) {
+        uint64_t local = 0;
+        graph.forEachNeighbor(v, [&](uint64_t u) {
+          local++;
+          cursor[u].fetch_add(1, std::memory_order_relaxed);
+        });
+        cursor[v].fetch_add(local, std::memory_order_relaxed);
+      }
+    }
+
+    offsets.resize(N + 1);
+    offsets[0] = 0;
+    for (int64_t v = 0; v < N; v++) {
+      offsets[v + 1] = offsets[v] + cursor[v].load(std::memory_order_relaxed);
+      cursor[v].store(offsets[v], std::memory_order_relaxed);
+    }
+
+    neighbors.resize(offsets[N]);
+
+    auto place = [&](uint64_t v, uint64_t u) {
+      neighbors[cursor[v].fetch_add(1, std::memory_order_relaxed)] = u;
+      neighbors[cursor[u].fetch_add(1, std::memory_order_relaxed)] = v;
+    };
+
+    if constexpr (edgeWalk) {
+      graph.forEachEdge(place);
+    } else {
+#pragma omp parallel for schedule(dynamic, 1024)
+      for (int64_t v = 0; v < N; v++) graph.forEachNeighbor(v, [&](uint64_t u) { place(v, u); });
+    }
+
+    degree.resize(N);
+
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t v = 0; v < N; v++) {
+      auto begin = neighbors.begin() + offsets[v];
+      auto end   = neighbors.begin() + offsets[v + 1];
+      std::sort(begin, end);
+      degree[v] = std::unique(begin, end) - begin;
+    }
+  }
+
+  uint64_t getVertexCount() const { return degree.size(); }
+
+  template <typename F>
+  void forEachNeighbor(uint64_t v, F&& f) const {
+    for (uint64_t i = offsets[v]; i < offsets[v] + degree[v]; ++i) f(neighbors[i]);
+  }
+};
+
+//Bucket peeling with a parallel frontier: every round removes all vertices sitting at the current minimum degree k,
+//decrements their neighbors and pushes the ones that fall to k into the next frontier of the same bucket.
+//Edges are treated as undirected.
+template <typename GraphT>
+CoreDecomposition core_decomposition(const GraphT& graph) {
+  DETRA_ZONE("metrics::core_decomposition");
+  SymmetricAdjacency sym(graph);
+
+  int64_t           N = sym.getVertexCount();
+  CoreDecomposition result;
+  result.core.resize(N);
+  result.ordering.resize(N);
+
+  std::vector<std::atomic<uint32_t>> degree(N);
+  for (int64_t v = 0; v < N; v++) degree[v].store(sym.degree[v], std::memory_order_relaxed);
+
+  std::vector<uint64_t> remaining(N);
+  for (int64_t v = 0; v < N; v++) remaining[v] = v;
+  int64_t R = N;
+
+  std::vector<uint64_t> frontier(N);
+  std::vector<uint64_t> next(N);
+  std::vector<uint64_t> survivors(N);
+
+  std::atomic<uint64_t> removed{0};
+  std::atomic<uint64_t> frontierSize{0};
+  std::atomic<uint64_t> nextSize{0};
+  std::atomic<uint64_t> survivorSize{0};
+
+  while (R > 0) {
+    uint32_t k = UINT32_MAX;
+
+#pragma omp parallel for reduction(min : k)
+    for (int64_t i = 0; i < R; i++) k = std::min(k, degree[remaining[i]].load(std::memory_order_relaxed));
+
+    frontierSize.store(0, std::memory_order_relaxed);
+    survivorSize.store(0, std::memory_order_relaxed);
+
+#pragma omp parallel for
+    for (int64_t i = 0; i < R; i++) {
+      uint64_t v = remaining[i];
+      if (degree[v].load(std::memory_order_relaxed) == k)
+        frontier[frontierSize.fetch_add(1, std::memory_order_relaxed)] = v;
+      else
+        survivors[survivorSize.fetch_add(1, std::memory_order_relaxed)] = v;
+    }
+
+    result.degeneracy = std::max(result.degeneracy, k);
+
+    while (frontierSize.load(std::memory_order_relaxed) > 0) {
+      int64_t F = frontierSize.load(std::memory_order_relaxed);
+      nextSize.store(0, std::memory_order_relaxed);
+
+#pragma omp parallel for schedule(dynamic, 256)
+      for (int64_t i = 0; i < F; i++) {
+        uint64_t v     = frontier[i];
+        result.core[v] = k;
+        result.ordering[removed.fetch_add(1, std::memory_order_relaxed)] = v;
+
+        sym.forEachNeighbor(v, [&](uint64_t u) {
+          uint32_t d = degree[u].load(std::memory_order_relaxed);
+          while (d > k && !degree[u].compare_exchange_weak(d, d - 1, std::memory_order_relaxed)) {}
+          if (d == k + 1) next[nextSize.fetch_add(1, std::memory_order_relaxed)] = u;
+        });
+      }
+
+      std::swap(frontier, next);
+      frontierSize.store(nextSize.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    //Vertices pulled into the bucket after the split still sit in survivors with degree k
+    int64_t               S = survivorSize.load(std::memory_order_relaxed);
+    std::atomic<uint64_t> kept{0};
+
+#pragma omp parallel for
+    for (int64_t i = 0; i < S; i++) {
+      uint64_t v = survivors[i];
+      if (degree[v].load(std::memory_order_relaxed) > k)
+        remaining[kept.fetch_add(1, std::memory_order_relaxed)] = v;
+    }
+
+    R = kept.load(std::memory_order_relaxed);
+  }
+
+  return result;
+}
+
+} // namespace metrics
+} // namespace graphs
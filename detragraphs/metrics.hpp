@@ -1,5 +1,6 @@
 #pragma once
 #include "graph.hpp"
+#include "profiling.hpp"
 #include <vector>
 namespace graphs {
 
@@ -7,6 +8,7 @@ namespace metrics {
 
 template <typename GraphT>
 std::vector<uint32_t> degree_sequence(const GraphT& graph) {
+  DETRA_ZONE("metrics::degree_sequence");
   int N = graph.getVertexCount();
 
   std::vector<uint32_t> degrees(N);
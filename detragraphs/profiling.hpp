@@ -0,0 +1,313 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <unordered_set>
+#include <vector>
+
+//Instrumentation layer, selected at configure time:
+//  -DUSE_TRACY=ON     defines DETRA_TRACY, zones/allocations are streamed to the Tracy profiler, counters are plotted
+//                     whenever a zone closes
+//  -DUSE_PROFILER=ON  defines DETRA_PROFILER, per zone timings, counters and per backend memory are summarised
+//                     to $DETRAGRAPHS_PROFILE_OUTPUT (default detragraphs_profile.txt) at exit or on
+//                     detra::profiling::report()
+//With neither, every macro expands to nothing and tracked containers are plain std containers.
+//
+//  DETRA_ZONE(name)                 times the enclosing scope, too heavy for per edge paths which only count
+//  DETRA_COUNT(name, delta)         adds delta to a named running counter
+//  DETRA_ALLOC/FREE(ptr, size, name) reports an allocation against a named memory pool
+
+#if defined(DETRA_TRACY) || defined(DETRA_PROFILER)
+#  define DETRA_PROFILING
+#endif
+
+#ifdef DETRA_PROFILING
+#  include <algorithm>
+#  include <atomic>
+#  include <chrono>
+#  include <cstdio>
+#  include <cstdlib>
+#  include <cstring>
+#  include <deque>
+#  include <mutex>
+#  ifdef DETRA_TRACY
+#    include <tracy/Tracy.hpp>
+#  endif
+
+namespace detra {
+namespace profiling {
+
+struct ZoneStats {
+  const char*           name;
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> totalNs{0};
+  std::atomic<uint64_t> maxNs{0};
+
+  explicit ZoneStats(const char* name) : name(name) {}
+};
+
+//Counters sit on per edge paths, so every thread bumps its own cell and the cells are only summed for the report
+//or, under Tracy, for the plots emitted when a zone closes
+struct CounterStats {
+  const char*                      name;
+  std::mutex                       lock;
+  std::deque<std::atomic<int64_t>> cells;
+
+  explicit CounterStats(const char* name) : name(name) {}
+
+  std::atomic<int64_t>& cell() {
+    std::lock_guard<std::mutex> guard(lock);
+    return cells.emplace_back(0);
+  }
+
+  int64_t sum() {
+    std::lock_guard<std::mutex> guard(lock);
+    int64_t                     result = 0;
+    for (auto& c : cells) result += c.load(std::memory_order_relaxed);
+    return result;
+  }
+};
+
+struct MemoryStats {
+  const char*           name;
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<int64_t>  live{0};
+  std::atomic<int64_t>  peak{0};
+
+  explicit MemoryStats(const char* name) : name(name) {}
+
+  inline void allocate(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t now  = live.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t prev = peak.load(std::memory_order_relaxed);
+    while (now > prev && !peak.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {}
+  }
+
+  inline void release(size_t size) { live.fetch_sub(size, std::memory_order_relaxed); }
+};
+
+//Stats are looked up by name once per call site and kept in deques so references stay valid
+struct Registry {
+  std::mutex               lock;
+  std::deque<ZoneStats>    zones;
+  std::deque<CounterStats> counters;
+  std::deque<MemoryStats>  memory;
+
+  template <typename T>
+  T& lookup(std::deque<T>& entries, const char* name) {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto& e : entries)
+      if (std::strcmp(e.name, name) == 0) return e;
+    return entries.emplace_back(name);
+  }
+
+  ZoneStats&    zone(const char* name) { return lookup(zones, name); }
+  CounterStats& counter(const char* name) { return lookup(counters, name); }
+  MemoryStats&  pool(const char* name) { return lookup(memory, name); }
+
+#  ifdef DETRA_TRACY
+  void plotCounters() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (auto& c : counters) TracyPlot(c.name, c.sum());
+  }
+#  endif
+};
+
+//Never destroyed: containers with static storage duration still report their frees after every destructor has run
+inline Registry& registry() {
+  static Registry* r = new Registry;
+  return *r;
+}
+
+//Writes the summary to $DETRAGRAPHS_PROFILE_OUTPUT (default detragraphs_profile.txt), overwriting any earlier one.
+//Called automatically at exit, the live column then holds what is still allocated at that point.
+inline void report() {
+#  ifdef DETRA_PROFILER
+  Registry&                   r = registry();
+  std::lock_guard<std::mutex> guard(r.lock);
+
+  const char* path = std::getenv("DETRAGRAPHS_PROFILE_OUTPUT");
+  FILE*       out  = std::fopen(path ? path : "detragraphs_profile.txt", "w");
+  if (!out) return;
+
+  std::vector<ZoneStats*> sorted;
+  for (auto& z : r.zones) sorted.push_back(&z);
+  std::sort(sorted.begin(), sorted.end(), [](ZoneStats* a, ZoneStats* b) { return a->totalNs.load() > b->totalNs.load(); });
+
+  std::fprintf(out, "%-40s %14s %14s %14s %14s\n", "zone", "calls", "total ms", "mean ns", "max ns");
+  for (auto* z : sorted) {
+    uint64_t calls = z->calls.load();
+    std::fprintf(out, "%-40s %14lu %14.3f %14.1f %14lu\n", z->name, calls, z->totalNs.load() / 1e6, calls ? double(z->totalNs.load()) / calls : 0.0, z->maxNs.load());
+  }
+
+  std::fprintf(out, "\n%-40s %14s\n", "counter", "total");
+  for (auto& c : r.counters) std::fprintf(out, "%-40s %14ld\n", c.name, c.sum());
+
+  std::fprintf(out, "\n%-40s %14s %14s %14s %14s\n", "memory", "allocations", "bytes", "live", "peak");
+  for (auto& m : r.memory) std::fprintf(out, "%-40s %14lu %14lu %14ld %14ld\n", m.name, m.allocations.load(), m.bytes.load(), m.live.load(), m.peak.load());
+
+  std::fclose(out);
+#  endif
+}
+
+#  ifdef DETRA_PROFILER
+//Registered during static initialisation of every translation unit including this header, before any global declared
+//after the include is constructed, so the handler runs once those globals have been destroyed
+inline const bool reportAtExit = (std::atexit(report), true);
+#  endif
+
+struct ScopedZone {
+  ZoneStats&                            stats;
+  std::chrono::steady_clock::time_point start;
+
+  explicit ScopedZone(ZoneStats& stats) : stats(stats), start(std::chrono::steady_clock::now()) {}
+
+  ~ScopedZone() {
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    stats.calls.fetch_add(1, std::memory_order_relaxed);
+    stats.totalNs.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t prev = stats.maxNs.load(std::memory_order_relaxed);
+    while (ns > prev && !stats.maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {}
+  }
+};
+
+#  ifdef DETRA_TRACY
+struct PlotCountersOnExit {
+  ~PlotCountersOnExit() { registry().plotCounters(); }
+};
+#  endif
+
+} // namespace profiling
+} // namespace detra
+#endif
+
+#define DETRA_CONCAT_(a, b) a##b
+#define DETRA_CONCAT(a, b)  DETRA_CONCAT_(a, b)
+
+#ifdef DETRA_PROFILING
+#  define DETRA_COUNT(name, delta)                                                                     \
+    do {                                                                                               \
+      static auto&       detraCounter = ::detra::profiling::registry().counter(name);                  \
+      thread_local auto& detraCell    = detraCounter.cell();                                           \
+      detraCell.store(detraCell.load(std::memory_order_relaxed) + (delta), std::memory_order_relaxed); \
+    } while (0)
+#endif
+
+#if defined(DETRA_TRACY)
+//Counters are plotted when the zone closes rather than on every increment
+#  define DETRA_ZONE(name) \
+    ZoneScopedN(name);     \
+    ::detra::profiling::PlotCountersOnExit DETRA_CONCAT(detraPlotCounters, __LINE__)
+#  define DETRA_ALLOC(ptr, size, name) TracyAllocN(ptr, size, name)
+#  define DETRA_FREE(ptr, size, name)  TracyFreeN(ptr, name)
+#elif defined(DETRA_PROFILER)
+#  define DETRA_ZONE(name)                                                                              \
+    static auto& DETRA_CONCAT(detraZoneStats, __LINE__) = ::detra::profiling::registry().zone(name); \
+    ::detra::profiling::ScopedZone DETRA_CONCAT(detraZone, __LINE__)(DETRA_CONCAT(detraZoneStats, __LINE__))
+#  define DETRA_ALLOC(ptr, size, name)                                    \
+    do {                                                                  \
+      static auto& detraPool = ::detra::profiling::registry().pool(name); \
+      detraPool.allocate(size);                                           \
+    } while (0)
+#  define DETRA_FREE(ptr, size, name)                                     \
+    do {                                                                  \
+      static auto& detraPool = ::detra::profiling::registry().pool(name); \
+      detraPool.release(size);                                            \
+    } while (0)
+#else
+#  define DETRA_ZONE(name)
+#  define DETRA_COUNT(name, delta)     ((void)0)
+#  define DETRA_ALLOC(ptr, size, name) ((void)0)
+#  define DETRA_FREE(ptr, size, name)  ((void)0)
+#endif
+
+//Declares the memory pool a backend reports its container allocations to
+#define DETRA_MEMORY_TAG(backend)                            \
+  struct MemoryTag {                                         \
+    static constexpr const char* name() { return #backend; } \
+  }
+
+//Same for backends templated on their element type, each instantiation gets its own pool, e.g. "AdjacencyMatrix<bool>".
+//The name is built once and never freed, pools and Tracy keep the pointer.
+#define DETRA_MEMORY_TAG_OF(backend, element)                                                       \
+  struct MemoryTag {                                                                                \
+    static const char* name() {                                                                     \
+      static const std::string* n =                                                                 \
+        new std::string(std::string(#backend "<") + ::detra::profiling::typeName<element>() + ">"); \
+      return n->c_str();                                                                            \
+    }                                                                                               \
+  }
+
+namespace detra {
+namespace profiling {
+
+//Readable names for the element types backends are instantiated with, mangled names for anything else
+template <typename T>
+inline const char* typeName() { return typeid(T).name(); }
+template <>
+inline const char* typeName<bool>() { return "bool"; }
+template <>
+inline const char* typeName<char>() { return "char"; }
+template <>
+inline const char* typeName<uint8_t>() { return "uint8_t"; }
+template <>
+inline const char* typeName<uint32_t>() { return "uint32_t"; }
+template <>
+inline const char* typeName<uint64_t>() { return "uint64_t"; }
+template <>
+inline const char* typeName<float>() { return "float"; }
+template <>
+inline const char* typeName<double>() { return "double"; }
+
+} // namespace profiling
+} // namespace detra
+
+namespace detra {
+namespace profiling {
+
+template <typename T, typename Tag>
+struct TrackedAllocator {
+  using value_type = T;
+
+  TrackedAllocator() = default;
+  template <typename U>
+  TrackedAllocator(const TrackedAllocator<U, Tag>&) {}
+
+  T* allocate(size_t n) {
+    T* p = std::allocator<T>{}.allocate(n);
+    DETRA_ALLOC(p, n * sizeof(T), Tag::name());
+    return p;
+  }
+
+  void deallocate(T* p, size_t n) {
+    DETRA_FREE(p, n * sizeof(T), Tag::name());
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const TrackedAllocator<U, Tag>&) const { return true; }
+  template <typename U>
+  bool operator!=(const TrackedAllocator<U, Tag>&) const { return false; }
+};
+
+#ifdef DETRA_PROFILING
+template <typename T, typename Tag>
+using Allocator = TrackedAllocator<T, Tag>;
+#else
+template <typename T, typename Tag>
+using Allocator = std::allocator<T>;
+#endif
+
+template <typename T, typename Tag>
+using TrackedVector = std::vector<T, Allocator<T, Tag>>;
+
+template <typename T, typename Tag, typename Hash = std::hash<T>, typename Equal = std::equal_to<T>>
+using TrackedUnorderedSet = std::unordered_set<T, Hash, Equal, Allocator<T, Tag>>;
+
+} // namespace profiling
+} // namespace detra
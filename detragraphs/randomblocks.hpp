@@ -0,0 +1,177 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace graphs {
+
+namespace random_blocks {
+
+inline uint64_t splitmix64(uint64_t& state) {
+  uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+  z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+inline uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+//kLanes interleaved xoshiro256** generators stored as structure of arrays so fill() auto vectorizes.
+//Lanes are long_jump (2^192) apart, jump() moves every lane 2^128 ahead to carve out independent per thread streams.
+struct Xoshiro256x8 {
+  static constexpr size_t kLanes = 8;
+
+  alignas(64) uint64_t s0[kLanes];
+  alignas(64) uint64_t s1[kLanes];
+  alignas(64) uint64_t s2[kLanes];
+  alignas(64) uint64_t s3[kLanes];
+
+  explicit Xoshiro256x8(uint64_t seed = 0x2545F4914F6CDD1Dull) { this->seed(seed); }
+
+  void seed(uint64_t seed) {
+    s0[0] = splitmix64(seed);
+    s1[0] = splitmix64(seed);
+    s2[0] = splitmix64(seed);
+    s3[0] = splitmix64(seed);
+    for (size_t l = 1; l < kLanes; ++l) {
+      s0[l] = s0[l - 1];
+      s1[l] = s1[l - 1];
+      s2[l] = s2[l - 1];
+      s3[l] = s3[l - 1];
+      polynomialJump(l, kLongJump);
+    }
+  }
+
+  void fill(uint64_t* out, size_t n) {
+    //State lives in locals for the whole block so the stores to out cannot alias it
+    alignas(64) uint64_t a[kLanes], b[kLanes], c[kLanes], d[kLanes];
+    std::memcpy(a, s0, sizeof(a));
+    std::memcpy(b, s1, sizeof(b));
+    std::memcpy(c, s2, sizeof(c));
+    std::memcpy(d, s3, sizeof(d));
+
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) step(a, b, c, d, out + i);
+
+    if (i < n) {
+      uint64_t tail[kLanes];
+      step(a, b, c, d, tail);
+      std::memcpy(out + i, tail, (n - i) * sizeof(uint64_t));
+    }
+
+    std::memcpy(s0, a, sizeof(a));
+    std::memcpy(s1, b, sizeof(b));
+    std::memcpy(s2, c, sizeof(c));
+    std::memcpy(s3, d, sizeof(d));
+  }
+
+  void jump(uint64_t times = 1) {
+    for (uint64_t t = 0; t < times; ++t)
+      for (size_t l = 0; l < kLanes; ++l) polynomialJump(l, kJump);
+  }
+
+  //Returns a generator at the current position and moves this one to the next stream
+  Xoshiro256x8 split() {
+    Xoshiro256x8 stream = *this;
+    jump();
+    return stream;
+  }
+
+private:
+  static constexpr uint64_t kJump[4]     = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+  static constexpr uint64_t kLongJump[4] = {0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull};
+
+  static inline void step(uint64_t* __restrict a, uint64_t* __restrict b, uint64_t* __restrict c, uint64_t* __restrict d, uint64_t* __restrict out) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      out[l]     = rotl(b[l] * 5, 7) * 9;
+      uint64_t t = b[l] << 17;
+      c[l] ^= a[l];
+      d[l] ^= b[l];
+      b[l] ^= c[l];
+      a[l] ^= d[l];
+      c[l] ^= t;
+      d[l] = rotl(d[l], 45);
+    }
+  }
+
+  void polynomialJump(size_t l, const uint64_t (&poly)[4]) {
+    uint64_t j0 = 0, j1 = 0, j2 = 0, j3 = 0;
+    for (int i = 0; i < 4; ++i) {
+      for (int b = 0; b < 64; ++b) {
+        if (poly[i] & (uint64_t(1) << b)) {
+          j0 ^= s0[l];
+          j1 ^= s1[l];
+          j2 ^= s2[l];
+          j3 ^= s3[l];
+        }
+        uint64_t t = s1[l] << 17;
+        s2[l] ^= s0[l];
+        s3[l] ^= s1[l];
+        s1[l] ^= s2[l];
+        s0[l] ^= s3[l];
+        s2[l] ^= t;
+        s3[l] = rotl(s3[l], 45);
+      }
+    }
+    s0[l] = j0;
+    s1[l] = j1;
+    s2[l] = j2;
+    s3[l] = j3;
+  }
+};
+
+//Buffered view over a RandomSource exposing the randi/randf/randb interface the generators use.
+//Sources with a fill(uint64_t*, size_t) member are drawn a block at a time, scalar sources such as
+//random_sources::XORand or random_sources::Standard are packed two randi() calls per 64 bit word.
+template <typename RandomSource, size_t kBlock = 256>
+struct Block {
+  RandomSource& source;
+
+  uint64_t buffer[kBlock];
+  size_t   cursor   = kBlock;
+  uint64_t bits     = 0;
+  int      bitsLeft = 0;
+
+  explicit Block(RandomSource& source) : source(source) {}
+
+  inline uint64_t randi() {
+    if (cursor == kBlock) refill();
+    return buffer[cursor++];
+  }
+
+  //Uniform in [0, 1) from the upper 24 bits
+  inline float randf() { return (randi() >> 40) * 0x1.0p-24f; }
+
+  //Uniform in [0, 1) from the upper 53 bits
+  inline double randd() { return (randi() >> 11) * 0x1.0p-53; }
+
+  inline bool randb() {
+    if (bitsLeft == 0) {
+      bits     = randi();
+      bitsLeft = 64;
+    }
+    bool b = bits & 1;
+    bits >>= 1;
+    --bitsLeft;
+    return b;
+  }
+
+  //Uniform in [0, n) by multiply shift, avoids the division of randi() % n
+  inline uint64_t randbelow(uint64_t n) {
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(randi()) * n) >> 64);
+  }
+
+private:
+  void refill() {
+    if constexpr (requires(RandomSource & r, uint64_t * p, size_t n) { r.fill(p, n); }) {
+      source.fill(buffer, kBlock);
+    } else {
+      for (size_t i = 0; i < kBlock; ++i)
+        buffer[i] = (uint64_t(source.randi()) << 32) ^ uint64_t(source.randi());
+    }
+    cursor = 0;
+  }
+};
+
+} // namespace random_blocks
+} // namespace graphs
@@ -1,64 +1,14 @@
 #include "generators.hpp"
 #include "graphbackend/graphbackend.hpp"
 #include "metrics.hpp"
+#include "kcore.hpp"
+#include "ensemble.hpp"
 #include "graph.hpp"
 #include "printer.hpp"
-#include <chrono>
 #include <iostream>
 
 using namespace graphs;
 
-void benchmark() {
-  using CGRaph = Graph<backends::AdjacencyMatrixFlat<char>>;
-
-  constexpr size_t N  = 20;
-  constexpr size_t m0 = 10;
-  constexpr size_t m  = 3;
-
-  CGRaph graph;
-
-  {
-    auto t0 = std::chrono::high_resolution_clock::now();
-
-    graph = generators::erdos_renyi_undirected<CGRaph, random_sources::Standard>(200, 0.4);
-
-    auto t1 = std::chrono::high_resolution_clock::now();
-
-    std::cout << "Graph generated in "
-              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
-              << " microseconds\n";
-  }
-
-  {
-
-    auto t0 = std::chrono::high_resolution_clock::now();
-
-    uint64_t total_edges = graph.getEdgeCount();
-
-    auto t1 = std::chrono::high_resolution_clock::now();
-
-    std::cout << "Edge counting: " << total_edges
-              << " edges in "
-              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
-              << " microseconds\n";
-  }
-  {
-    auto t0 = std::chrono::high_resolution_clock::now();
-
-    size_t connected_count = 0;
-    for (size_t i = 0; i < N; ++i)
-      for (size_t j = i + 1; j < N; ++j)
-        connected_count += graph.isConnected(j, i);
-
-    auto t1 = std::chrono::high_resolution_clock::now();
-
-    std::cout << "Full connectivity check counted " << connected_count
-              << " connections in "
-              << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count()
-              << " microseconds\n";
-  }
-}
-
 void test_prefferential() {
   printer::vector(metrics::degree_sequence(generators::prefferential_directed<backends::AdjacencyListVector, random_sources::XORand>(400, 9000)));
 }
@@ -67,7 +17,28 @@ void test_tree() {
   printer::vector(metrics::degree_sequence(generators::recursive_tree<backends::AdjacencyListVector, random_sources::XORand>(7, 3, 0.9)));
 }
 
+void test_cores() {
+  auto cores = metrics::core_decomposition(generators::barabasi_albert_undirected<backends::AdjacencyListVector, random_sources::XORand>(400, 10, 3));
+  std::cout << "Degeneracy: " << cores.degeneracy << std::endl;
+  printer::vector(cores.core);
+}
+
+void test_ensemble() {
+  using G       = backends::AdjacencyListVector;
+  using Metrics = ensemble::MetricSet<ensemble::DegreeHistogram, ensemble::EdgeCount>;
+
+  auto result = ensemble::run<G>(1000, [](G& g, random_blocks::Xoshiro256x8& rng, generators::Workspace& workspace) {
+    generators::prefferential_directed(g, 400, 9000, rng, workspace);
+  }, Metrics{});
+
+  std::cout << "Mean edges: " << result.get<ensemble::EdgeCount>().mean() << std::endl;
+  printer::vector(result.get<ensemble::DegreeHistogram>().mean());
+}
+
 int main() {
   test_prefferential();
   test_tree();
+  test_cores();
+  test_ensemble();
   return 0;
+}